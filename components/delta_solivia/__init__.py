@@ -1,8 +1,10 @@
 import logging
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome import pins
+from esphome import pins, automation
+from esphome.automation import maybe_simple_id
 from esphome.cpp_helpers import gpio_pin_expression
+from esphome.core import CORE
 from esphome.components import uart, sensor, text_sensor
 from esphome.const import (
     CONF_ID,
@@ -37,10 +39,19 @@ AUTO_LOAD    = ["sensor", "text_sensor"]
 delta_solivia_ns      = cg.esphome_ns.namespace("delta_solivia")
 DeltaSoliviaComponent = delta_solivia_ns.class_("DeltaSoliviaComponent", uart.UARTDevice, cg.PollingComponent)
 DeltaSoliviaInverter  = delta_solivia_ns.class_("DeltaSoliviaInverter")
+DumpCaptureAction     = delta_solivia_ns.class_("DumpCaptureAction", automation.Action)
+ClearCaptureAction    = delta_solivia_ns.class_("ClearCaptureAction", automation.Action)
+ReplayAction          = delta_solivia_ns.class_("ReplayAction", automation.Action)
+StopReplayAction      = delta_solivia_ns.class_("StopReplayAction", automation.Action)
 
 # global config
 CONF_INVERTERS = "inverters"
 CONF_HAS_GATEWAY = "has_gateway"
+CONF_CAPTURE_SIZE = "capture_size"
+
+# replay action config
+CONF_REPLAY_DATA     = "data"
+CONF_REPLAY_REALTIME = "realtime"
 
 # per-inverter config
 CONF_INV_ADDRESS  = "address"
@@ -64,6 +75,15 @@ CONF_INV_RUNTIME_MINUTES       = "runtime_minutes"
 CONF_INV_MAX_AC_POWER          = "max_ac_power_today"
 CONF_INV_MAX_SOLAR_INPUT_POWER = "max_solar_input_power"
 
+def _validate_capture_size(value):
+    value = cv.int_range(min = 512)(value)
+    # the capture buffer (and a copy of it while replaying) should fit in
+    # memory: ESP8266 has no PSRAM, ESP32 only allows large sizes with PSRAM
+    limit = 8 * 1024 if CORE.is_esp8266 else 1024 * 1024
+    if value > limit:
+        raise cv.Invalid(f"Capture size can't be larger than {limit} bytes on this platform")
+    return value
+
 def _validate_inverters(config):
     if len(config) < 1:
         raise cv.Invalid("Need at least one inverter to be configured")
@@ -175,6 +195,7 @@ CONFIG_SCHEMA = cv.All(
         cv.GenerateID(): cv.declare_id(DeltaSoliviaComponent),
         cv.Optional(CONF_FLOW_CONTROL_PIN): pins.gpio_output_pin_schema,
         cv.Optional(CONF_HAS_GATEWAY, default = False): cv.boolean,
+        cv.Optional(CONF_CAPTURE_SIZE): _validate_capture_size,
         cv.Required(CONF_INVERTERS): cv.All(cv.ensure_list(INVERTER_SCHEMA), _validate_inverters),
     })
     .extend(cv.polling_component_schema("5s"))
@@ -202,6 +223,10 @@ async def to_code(config):
         cg.add(component.set_update_interval(500))
     cg.add(component.set_has_gateway(has_gateway))
 
+    # raw frame capture buffer (allocated in PSRAM when available)
+    if CONF_CAPTURE_SIZE in config:
+        cg.add(component.set_capture_size(config[CONF_CAPTURE_SIZE]))
+
     for inverter_config in config[CONF_INVERTERS]:
         address  = inverter_config[CONF_INV_ADDRESS]
         throttle = inverter_config[CONF_INV_THROTTLE];
@@ -258,3 +283,46 @@ async def to_code(config):
 
         # add inverter to component
         cg.add(component.add_inverter(inverter))
+
+CAPTURE_ACTION_SCHEMA = maybe_simple_id({
+    cv.GenerateID(): cv.use_id(DeltaSoliviaComponent),
+})
+
+@automation.register_action("delta_solivia.dump_capture", DumpCaptureAction, CAPTURE_ACTION_SCHEMA)
+async def dump_capture_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+@automation.register_action("delta_solivia.clear_capture", ClearCaptureAction, CAPTURE_ACTION_SCHEMA)
+async def clear_capture_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+@automation.register_action("delta_solivia.stop_replay", StopReplayAction, CAPTURE_ACTION_SCHEMA)
+async def stop_replay_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+@automation.register_action(
+    "delta_solivia.replay",
+    ReplayAction,
+    cv.Schema({
+        cv.GenerateID(): cv.use_id(DeltaSoliviaComponent),
+        cv.Optional(CONF_REPLAY_DATA): cv.templatable(cv.string),
+        cv.Optional(CONF_REPLAY_REALTIME, default = True): cv.templatable(cv.boolean),
+    })
+)
+async def replay_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+
+    if CONF_REPLAY_DATA in config:
+        data = await cg.templatable(config[CONF_REPLAY_DATA], args, cg.std_string)
+        cg.add(var.set_data(data))
+
+    realtime = await cg.templatable(config[CONF_REPLAY_REALTIME], args, bool)
+    cg.add(var.set_realtime(realtime))
+    return var
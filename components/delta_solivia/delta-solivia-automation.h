@@ -0,0 +1,37 @@
+#pragma once
+
+#include "esphome.h"
+#include "delta-solivia-component.h"
+
+namespace esphome {
+namespace delta_solivia {
+
+template<typename... Ts> class DumpCaptureAction : public Action<Ts...>, public Parented<DeltaSoliviaComponent> {
+  public:
+    void play(Ts... x) override { this->parent_->dump_capture(); }
+};
+
+template<typename... Ts> class ClearCaptureAction : public Action<Ts...>, public Parented<DeltaSoliviaComponent> {
+  public:
+    void play(Ts... x) override { this->parent_->clear_capture(); }
+};
+
+template<typename... Ts> class ReplayAction : public Action<Ts...>, public Parented<DeltaSoliviaComponent> {
+  public:
+    TEMPLATABLE_VALUE(std::string, data)
+    TEMPLATABLE_VALUE(bool, realtime)
+
+    void play(Ts... x) override {
+      // without data, the capture buffer itself is replayed
+      std::string data = this->data_.has_value() ? this->data_.value(x...) : "";
+      this->parent_->start_replay(data, this->realtime_.value_or(x..., true));
+    }
+};
+
+template<typename... Ts> class StopReplayAction : public Action<Ts...>, public Parented<DeltaSoliviaComponent> {
+  public:
+    void play(Ts... x) override { this->parent_->stop_replay(); }
+};
+
+}
+}
@@ -0,0 +1,242 @@
+#include "delta-solivia-capture.h"
+
+namespace esphome {
+namespace delta_solivia {
+
+// allocate ring buffer (prefers PSRAM when available)
+bool FrameCapture::allocate(size_t size) {
+  RAMAllocator<uint8_t> allocator;
+  buffer = allocator.allocate(size);
+  if (buffer == nullptr) {
+    return false;
+  }
+  capacity = size;
+  clear();
+  return true;
+}
+
+// record a frame, dropping the oldest records if there isn't enough room
+void FrameCapture::record(CaptureKind kind, const uint8_t* bytes, size_t len) {
+  if (buffer == nullptr) {
+    return;
+  }
+
+  const size_t needed = CAPTURE_RECORD_HEADER_SIZE + len;
+  if (frozen || len > 0xFFFF || needed > capacity) {
+    dropped++;
+    return;
+  }
+
+  while (capacity - used < needed) {
+    drop_oldest();
+  }
+
+  const uint32_t now = millis();
+  const uint8_t header[CAPTURE_RECORD_HEADER_SIZE] = {
+    kind,
+    (uint8_t) (now),
+    (uint8_t) (now >> 8),
+    (uint8_t) (now >> 16),
+    (uint8_t) (now >> 24),
+    (uint8_t) (len),
+    (uint8_t) (len >> 8),
+  };
+  write_bytes(header, sizeof(header));
+  write_bytes(bytes, len);
+  records++;
+}
+
+void FrameCapture::clear() {
+  head = tail = used = 0;
+  records = dropped = 0;
+}
+
+// read up to `len` bytes of the exported capture, starting at `offset`
+size_t FrameCapture::read_export(size_t offset, uint8_t* out, size_t len) const {
+  size_t copied = 0;
+
+  while (copied < len && offset < sizeof(CAPTURE_MAGIC)) {
+    out[copied++] = CAPTURE_MAGIC[offset++];
+  }
+
+  if (copied < len && offset < export_size()) {
+    const size_t count = std::min(len - copied, export_size() - offset);
+    read_bytes((tail + offset - sizeof(CAPTURE_MAGIC)) % capacity, out + copied, count);
+    copied += count;
+  }
+
+  return copied;
+}
+
+void FrameCapture::write_bytes(const uint8_t* bytes, size_t len) {
+  const size_t first = std::min(len, capacity - head);
+  memcpy(buffer + head, bytes, first);
+  memcpy(buffer, bytes + first, len - first);
+  head  = (head + len) % capacity;
+  used += len;
+}
+
+void FrameCapture::read_bytes(size_t pos, uint8_t* out, size_t len) const {
+  const size_t first = std::min(len, capacity - pos);
+  memcpy(out, buffer + pos, first);
+  memcpy(out + first, buffer, len - first);
+}
+
+void FrameCapture::drop_oldest() {
+  uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+  read_bytes(tail, header, sizeof(header));
+
+  const size_t size = CAPTURE_RECORD_HEADER_SIZE + (header[5] | (header[6] << 8));
+  tail  = (tail + size) % capacity;
+  used -= size;
+  records--;
+  dropped++;
+}
+
+bool CaptureReplay::allocate(size_t size_) {
+  release();
+
+  RAMAllocator<uint8_t> allocator;
+  data = allocator.allocate(size_);
+  if (data == nullptr) {
+    return false;
+  }
+  size = size_;
+  pos  = sizeof(CAPTURE_MAGIC);
+  return true;
+}
+
+void CaptureReplay::release() {
+  if (data != nullptr) {
+    RAMAllocator<uint8_t> allocator;
+    allocator.deallocate(data, size);
+  }
+  capture = nullptr;
+  data    = nullptr;
+  size    = pos = 0;
+}
+
+// read records in place from the capture ring, which should be frozen
+// for as long as the replay runs
+void CaptureReplay::load_capture(const FrameCapture& capture_) {
+  release();
+  capture = &capture_;
+  size    = capture_.export_size();
+  pos     = sizeof(CAPTURE_MAGIC);
+}
+
+size_t CaptureReplay::read(size_t offset, uint8_t* out, size_t len) const {
+  if (capture != nullptr) {
+    return capture->read_export(offset, out, len);
+  }
+  if (offset >= size) {
+    return 0;
+  }
+  len = std::min(len, size - offset);
+  memcpy(out, data + offset, len);
+  return len;
+}
+
+// decode a hex dump; whitespace is ignored, and when the text contains
+// `|` delimiters (as logged by dump_capture()) only the characters
+// between each pair of delimiters are used, so log lines can be pasted
+// verbatim
+bool CaptureReplay::load_hex(const std::string& hex) {
+  release();
+
+  const bool delimited = hex.find('|') != std::string::npos;
+
+  // first pass validates and counts the digits, second pass decodes
+  size_t digits = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    bool   inside = ! delimited;
+    size_t digit  = 0;
+
+    for (char c : hex) {
+      const unsigned char ch = (unsigned char) c;
+
+      if (delimited && ch == '|') {
+        inside = ! inside;
+        continue;
+      }
+      if (! inside || isspace(ch)) {
+        continue;
+      }
+      if (! isxdigit(ch)) {
+        release();
+        return false;
+      }
+
+      if (pass == 1) {
+        const uint8_t nibble = isdigit(ch) ? ch - '0' : (tolower(ch) - 'a' + 10);
+        if (digit % 2 == 0) {
+          data[digit / 2] = nibble << 4;
+        } else {
+          data[digit / 2] |= nibble;
+        }
+      }
+      digit++;
+    }
+
+    if (pass == 0) {
+      digits = digit;
+      if (digits % 2 != 0 || ! allocate(digits / 2)) {
+        return false;
+      }
+    }
+  }
+
+  return validate();
+}
+
+// make sure the magic is present and all records are complete
+bool CaptureReplay::validate() {
+  if (size < sizeof(CAPTURE_MAGIC) || memcmp(data, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC)) != 0) {
+    release();
+    return false;
+  }
+
+  size_t offset = sizeof(CAPTURE_MAGIC);
+  while (offset < size) {
+    if (size - offset < CAPTURE_RECORD_HEADER_SIZE) {
+      break;
+    }
+    offset += CAPTURE_RECORD_HEADER_SIZE + (data[offset + 5] | (data[offset + 6] << 8));
+  }
+  if (offset != size) {
+    release();
+    return false;
+  }
+
+  return true;
+}
+
+bool CaptureReplay::peek(CaptureRecord& record) const {
+  uint8_t header[CAPTURE_RECORD_HEADER_SIZE];
+  if (read(pos, header, sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+
+  record.kind      = header[0];
+  record.timestamp = header[1] | (header[2] << 8) | (header[3] << 16) | ((uint32_t) header[4] << 24);
+  record.length    = header[5] | (header[6] << 8);
+  return true;
+}
+
+// move to the next record, optionally copying the frame bytes of
+// the current one
+void CaptureReplay::advance(std::vector<uint8_t>* frame) {
+  CaptureRecord record;
+  if (! peek(record)) {
+    return;
+  }
+
+  if (frame != nullptr) {
+    frame->resize(record.length);
+    frame->resize(read(pos + CAPTURE_RECORD_HEADER_SIZE, frame->data(), record.length));
+  }
+  pos += CAPTURE_RECORD_HEADER_SIZE + record.length;
+}
+
+}
+}
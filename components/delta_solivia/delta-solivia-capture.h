@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "esphome.h"
+
+namespace esphome {
+namespace delta_solivia {
+
+// record types stored in a capture
+enum CaptureKind : uint8_t {
+  CAPTURE_RX        = 0x01, // frame received from the bus, accepted by process_frame()
+  CAPTURE_TX        = 0x02, // frame sent to the bus
+  CAPTURE_REJECT    = 0x03, // frame received from the bus, rejected by process_frame()
+  CAPTURE_THROTTLED = 0x04, // frame received from the bus, not validated because of throttling
+  CAPTURE_DISCARD   = 0x05, // bytes skipped while looking for a valid header
+};
+
+// Exported capture format (all integers little endian):
+//
+//   "DSC1"                         magic
+//   repeated, oldest first:
+//     kind        (1 byte)         see CaptureKind
+//     timestamp   (4 bytes)        millis() when recorded
+//     length      (2 bytes)        number of frame bytes
+//     frame bytes (length bytes)
+//
+// The ring buffer stores records in exactly this layout, so exporting
+// it is just a matter of prepending the magic.
+static const uint8_t CAPTURE_MAGIC[]            = { 'D', 'S', 'C', '1' };
+static const size_t  CAPTURE_RECORD_HEADER_SIZE = 7;
+
+struct CaptureRecord {
+  uint8_t  kind;
+  uint32_t timestamp;
+  uint16_t length;
+};
+
+// fixed-size ring of timestamped frames, oldest records are dropped
+// to make room for new ones
+class FrameCapture {
+  uint8_t* buffer{nullptr};
+  size_t   capacity{0};
+  size_t   head{0};
+  size_t   tail{0};
+  size_t   used{0};
+  uint32_t records{0};
+  uint32_t dropped{0};
+  bool     frozen{false};
+
+  void write_bytes(const uint8_t*, size_t);
+  void read_bytes(size_t, uint8_t*, size_t) const;
+  void drop_oldest();
+
+  public:
+    bool allocate(size_t);
+    bool is_allocated() const { return buffer != nullptr; }
+    uint32_t get_records() const { return records; }
+    uint32_t get_dropped() const { return dropped; }
+
+    // while frozen, new records are counted as dropped so the
+    // contents can be read out without being overwritten
+    void set_frozen(bool frozen_) { frozen = frozen_; }
+
+    void record(CaptureKind, const uint8_t*, size_t);
+    void clear();
+
+    // read the capture in export format, without copying the whole ring
+    size_t export_size() const { return sizeof(CAPTURE_MAGIC) + used; }
+    size_t read_export(size_t, uint8_t*, size_t) const;
+};
+
+// walks the records of an exported capture, either read in place from
+// a (frozen) capture ring, or from decoded hex data kept in a buffer
+// allocated in PSRAM when available
+class CaptureReplay {
+  const FrameCapture* capture{nullptr};
+  uint8_t* data{nullptr};
+  size_t   size{0};
+  size_t   pos{0};
+
+  bool allocate(size_t);
+  bool validate();
+  size_t read(size_t, uint8_t*, size_t) const;
+
+  public:
+    void load_capture(const FrameCapture&);
+    bool load_hex(const std::string&);
+    void release();
+    bool peek(CaptureRecord&) const;
+    void advance(std::vector<uint8_t>* = nullptr);
+};
+
+}
+}
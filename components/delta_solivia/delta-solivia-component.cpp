@@ -1,5 +1,6 @@
 #include "delta-solivia-component.h"
 #include "delta-solivia-crc.h"
+#include "variant-15-parser.h"
 
 namespace esphome {
 namespace delta_solivia {
@@ -9,6 +10,23 @@ void DeltaSoliviaComponent::setup() {
     flow_control_pin->setup();
     flow_control_pin->digital_write(false);
   }
+
+  if (capture_size > 0) {
+    if (capture.allocate(capture_size)) {
+      ESP_LOGD(LOG_TAG, "CONFIG - capturing frames into %u byte buffer", (unsigned) capture_size);
+    } else {
+      ESP_LOGE(LOG_TAG, "CONFIG - unable to allocate %u byte capture buffer", (unsigned) capture_size);
+    }
+  }
+}
+
+void DeltaSoliviaComponent::loop() {
+  if (dumping) {
+    dump_step();
+  }
+  if (replaying) {
+    replay_step();
+  }
 }
 
 // add an inverter
@@ -24,6 +42,22 @@ DeltaSoliviaInverter* DeltaSoliviaComponent::get_inverter(uint8_t address) {
 
 // process an incoming packet
 bool DeltaSoliviaComponent::process_frame(const Frame& frame) {
+  if (! validate_frame(frame)) {
+    return false;
+  }
+
+  // update inverter
+  auto inverter = get_inverter(frame[2]);
+  uint8_t buffer[frame.size()];
+  std::copy(frame.begin(), frame.end(), buffer); // copy vector to plain byte buffer
+  inverter->update_sensors(buffer);
+
+  // done
+  return true;
+}
+
+// validate packet header, size and trailer
+bool DeltaSoliviaComponent::validate_frame(const Frame& frame) {
   if (! validate_header(frame)) {
     ESP_LOGD(LOG_TAG, "FRAME - incorrect header");
     return false;
@@ -33,18 +67,11 @@ bool DeltaSoliviaComponent::process_frame(const Frame& frame) {
     return false;
   }
 
-  if (! validate_trailer(frame)) {
+  if (! validate_data_size(frame)) {
     return false;
   }
 
-  // update inverter
-  auto inverter = get_inverter(frame[2]);
-  uint8_t buffer[frame.size()];
-  std::copy(frame.begin(), frame.end(), buffer); // copy vector to plain byte buffer
-  inverter->update_sensors(buffer);
-
-  // done
-  return true;
+  return validate_trailer(frame);
 }
 
 // validate packet header
@@ -82,6 +109,18 @@ bool DeltaSoliviaComponent::validate_size(const Frame& frame) {
   return true;
 }
 
+// make sure the frame holds all the data the parser reads
+bool DeltaSoliviaComponent::validate_data_size(const Frame& frame) {
+  // data size includes command and sub command
+  unsigned int data_size = frame[3] >= 2 ? frame[3] - 2 : 0;
+
+  if (data_size < Variant15Parser::DATA_SIZE) {
+    ESP_LOGD(LOG_TAG, "FRAME - data too short (was %u, expected at least %u)", data_size, (unsigned) Variant15Parser::DATA_SIZE);
+    return false;
+  }
+  return true;
+}
+
 bool DeltaSoliviaComponent::validate_address(const Frame& frame) {
   unsigned int address = frame[2];
   auto inverter        = get_inverter(address);
@@ -131,6 +170,7 @@ void DeltaSoliviaComponent::update_without_gateway() {
       if (this->flow_control_pin != nullptr) {
         this->flow_control_pin->digital_write(true);
       }
+      this->capture.record(CAPTURE_TX, bytes, len);
       this->write_array(bytes, len);
       this->flush();
       if (this->flow_control_pin != nullptr) {
@@ -168,13 +208,16 @@ void DeltaSoliviaComponent::update_without_gateway() {
 
   // process frame
   Frame frame(buffer, buffer + bytes_read);
-  process_frame(frame);
+  capture_frame(frame, process_frame(frame) ? CAPTURE_RX : CAPTURE_REJECT);
 }
 
 void DeltaSoliviaComponent::update_with_gateway() {
   // buffer to store serial data
   static Frame frame;
 
+  // bytes skipped while looking for a valid header
+  static Frame discarded;
+
   // read data off UART
   while (available() > 0) {
     // add new bytes to buffer
@@ -187,10 +230,19 @@ void DeltaSoliviaComponent::update_with_gateway() {
 
     // validate header
     if (! validate_header(frame)) {
+      if (capture.is_allocated()) {
+        discarded.push_back(frame.front());
+        if (discarded.size() >= 64) {
+          capture_discarded(discarded);
+        }
+      }
       frame.erase(frame.begin());
       continue;
     }
 
+    // found a header, record anything that was skipped to get here
+    capture_discarded(discarded);
+
     // read full packet
     unsigned int required_size = 4 + frame[3] + 3;
     if (frame.size() != required_size) {
@@ -202,8 +254,12 @@ void DeltaSoliviaComponent::update_with_gateway() {
     unsigned int now                = millis();
     if (now - last_update >= throttle) {
       // process frame
-      process_frame(frame);
+      capture_frame(frame, process_frame(frame) ? CAPTURE_RX : CAPTURE_REJECT);
       last_update = millis();
+    } else {
+      // throttled frames aren't validated, but are still recorded
+      // so replays see all traffic
+      capture_frame(frame, CAPTURE_THROTTLED);
     }
 
     // clear vector for next round
@@ -211,5 +267,177 @@ void DeltaSoliviaComponent::update_with_gateway() {
   }
 }
 
+// record a received frame in the capture buffer
+void DeltaSoliviaComponent::capture_frame(const Frame& frame, CaptureKind kind) {
+  capture.record(kind, frame.data(), frame.size());
+}
+
+// record (and clear) bytes that were skipped during header resync
+void DeltaSoliviaComponent::capture_discarded(Frame& discarded) {
+  if (discarded.empty()) {
+    return;
+  }
+  capture.record(CAPTURE_DISCARD, discarded.data(), discarded.size());
+  discarded.clear();
+}
+
+// dump capture to the log as hex lines; the data on each line is
+// enclosed in `|` so the lines can be pasted verbatim into start_replay()
+void DeltaSoliviaComponent::dump_capture() {
+  if (! capture.is_allocated()) {
+    ESP_LOGW(LOG_TAG, "CAPTURE - capturing is disabled (set capture_size)");
+    return;
+  }
+
+  if (dumping) {
+    ESP_LOGW(LOG_TAG, "CAPTURE - dump already running");
+    return;
+  }
+
+  // stop recording until the dump is done, so the ring isn't
+  // overwritten while it's being read out
+  dumping     = true;
+  dump_offset = 0;
+  update_capture_frozen();
+  ESP_LOGI(LOG_TAG, "CAPTURE - begin, %u records, %u dropped, %u bytes",
+    (unsigned) capture.get_records(),
+    (unsigned) capture.get_dropped(),
+    (unsigned) capture.export_size()
+  );
+}
+
+// log a limited number of lines per loop to not flood the logger; each
+// line starts with its byte offset so missing lines can be spotted
+void DeltaSoliviaComponent::dump_step() {
+  const size_t bytes_per_line = 32;
+  const size_t lines_per_loop = 8;
+  uint8_t line[bytes_per_line];
+
+  for (size_t i = 0; i < lines_per_loop; i++) {
+    size_t len = capture.read_export(dump_offset, line, bytes_per_line);
+    if (len == 0) {
+      ESP_LOGI(LOG_TAG, "CAPTURE - end");
+      dumping = false;
+      update_capture_frozen();
+      return;
+    }
+    ESP_LOGI(LOG_TAG, "CAPTURE - %06X |%s|", (unsigned) dump_offset, format_hex(line, len).c_str());
+    dump_offset += len;
+  }
+}
+
+void DeltaSoliviaComponent::clear_capture() {
+  if (dumping || replaying_capture) {
+    ESP_LOGW(LOG_TAG, "CAPTURE - can't clear while the capture is being dumped or replayed");
+    return;
+  }
+  capture.clear();
+  ESP_LOGI(LOG_TAG, "CAPTURE - cleared");
+}
+
+// replay a hex encoded capture (or the capture buffer when empty), either
+// at recorded speed or as fast as possible
+void DeltaSoliviaComponent::start_replay(const std::string& hex, bool realtime) {
+  if (replaying) {
+    ESP_LOGW(LOG_TAG, "REPLAY - already running");
+    return;
+  }
+
+  if (hex.empty()) {
+    if (! capture.is_allocated()) {
+      ESP_LOGW(LOG_TAG, "REPLAY - capturing is disabled (set capture_size)");
+      return;
+    }
+    replay.load_capture(capture);
+  } else if (! replay.load_hex(hex)) {
+    ESP_LOGE(LOG_TAG, "REPLAY - invalid capture data, or not enough memory to hold it");
+    return;
+  }
+
+  CaptureRecord record;
+  if (! replay.peek(record)) {
+    ESP_LOGW(LOG_TAG, "REPLAY - capture is empty");
+    replay.release();
+    return;
+  }
+
+  // the capture buffer is replayed in place, so stop recording into it
+  replaying              = true;
+  replaying_capture      = hex.empty();
+  replay_realtime        = realtime;
+  replay_started         = millis();
+  replay_first_timestamp = record.timestamp;
+  replay_frames          = 0;
+  replay_rejects         = 0;
+  replay_decode_us       = 0;
+  update_capture_frozen();
+  ESP_LOGI(LOG_TAG, "REPLAY - started (%s)", realtime ? "recorded speed" : "maximum speed");
+}
+
+void DeltaSoliviaComponent::stop_replay() {
+  if (replaying) {
+    finish_replay("stopped");
+  }
+}
+
+// process a limited number of records per loop to not trip the watchdog
+void DeltaSoliviaComponent::replay_step() {
+  const size_t records_per_loop = 16;
+  CaptureRecord record;
+
+  for (size_t i = 0; i < records_per_loop; i++) {
+    if (! replay.peek(record)) {
+      finish_replay("done");
+      return;
+    }
+
+    // wait until the record is due
+    if (replay_realtime && millis() - replay_started < record.timestamp - replay_first_timestamp) {
+      return;
+    }
+
+    // only frames that were received are fed back
+    if (record.kind == CAPTURE_TX || record.kind == CAPTURE_DISCARD) {
+      replay.advance();
+      continue;
+    }
+
+    // validate and parse, but don't update the inverter sensors
+    Frame frame;
+    replay.advance(&frame);
+    uint32_t start = micros();
+    bool accepted  = validate_frame(frame);
+    if (accepted) {
+      Variant15Parser parser(frame.data(), true);
+      parser.parse();
+    }
+    replay_decode_us += micros() - start;
+
+    replay_frames++;
+    if (! accepted) {
+      replay_rejects++;
+    }
+  }
+}
+
+void DeltaSoliviaComponent::finish_replay(const char* reason) {
+  replaying         = false;
+  replaying_capture = false;
+  replay.release();
+  update_capture_frozen();
+  ESP_LOGI(LOG_TAG, "REPLAY - %s, %u frames (%u rejected) decoded in %u us",
+    reason,
+    (unsigned) replay_frames,
+    (unsigned) replay_rejects,
+    (unsigned) replay_decode_us
+  );
+}
+
+// the capture buffer is read in place by dumps and replays, so no new
+// records are written into it while either is running
+void DeltaSoliviaComponent::update_capture_frozen() {
+  capture.set_frozen(dumping || replaying_capture);
+}
+
 }
 }
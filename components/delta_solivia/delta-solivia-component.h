@@ -5,6 +5,7 @@
 #include "esphome.h"
 #include "esphome/components/uart/uart.h"
 #include "delta-solivia-crc.h"
+#include "delta-solivia-capture.h"
 
 namespace esphome {
 namespace delta_solivia {
@@ -24,24 +25,57 @@ class DeltaSoliviaComponent: public PollingComponent, public UARTDevice {
   GPIOPin *flow_control_pin{nullptr};
   bool has_gateway;
 
+  // raw frame capture
+  size_t capture_size{0};
+  FrameCapture capture;
+  bool dumping{false};
+  size_t dump_offset{0};
+
+  // replay of a capture through validate_frame() and the parser,
+  // without publishing any sensor values
+  CaptureReplay replay;
+  bool replaying{false};
+  bool replaying_capture{false};
+  bool replay_realtime{true};
+  uint32_t replay_started{0};
+  uint32_t replay_first_timestamp{0};
+  uint32_t replay_frames{0};
+  uint32_t replay_rejects{0};
+  uint32_t replay_decode_us{0};
+
+  void capture_frame(const Frame&, CaptureKind);
+  void capture_discarded(Frame&);
+  void dump_step();
+  void replay_step();
+  void finish_replay(const char*);
+  void update_capture_frozen();
+
   public:
     DeltaSoliviaComponent() : has_gateway(false), throttle(10000) {}
 
     void set_throttle(unsigned int throttle_) { throttle = throttle_; }
     void set_flow_control_pin(GPIOPin *flow_control_pin_) { flow_control_pin = flow_control_pin_; }
     void set_has_gateway(bool has_gateway_) { has_gateway = has_gateway_; }
+    void set_capture_size(size_t capture_size_) { capture_size = capture_size_; }
 
     void setup() override;
+    void loop() override;
     void update() override;
     void add_inverter(DeltaSoliviaInverter*);
     DeltaSoliviaInverter* get_inverter(uint8_t);
     bool process_frame(const Frame&);
+    bool validate_frame(const Frame&);
     bool validate_header(const Frame&);
     bool validate_size(const Frame&);
+    bool validate_data_size(const Frame&);
     bool validate_address(const Frame&);
     bool validate_trailer(const Frame&);
     void update_without_gateway();
     void update_with_gateway();
+    void dump_capture();
+    void clear_capture();
+    void start_replay(const std::string&, bool);
+    void stop_replay();
 };
 
 }
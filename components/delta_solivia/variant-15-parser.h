@@ -22,6 +22,9 @@ static float applyScaling(uint32_t value, float scale) {
 
 class Variant15Parser {
 public:
+  // number of data bytes read by parse(), following the 6 byte header
+  static const size_t DATA_SIZE = 115;
+
   // Data fields
   std::string SAP_part_number;
   std::string SAP_serial_number;